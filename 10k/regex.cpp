@@ -7,6 +7,8 @@
 #include <vector>
 #include <windows.h>
 
+#include "../instrumentation/instrument.h"
+
 struct CompanyFile {
     std::string name;
     std::string filename;
@@ -79,53 +81,74 @@ int main() {
     }
 
     // Step 1. Read entire text
-    std::ifstream file(filename);
-    if (!file) {
-        std::cerr << "Could not open file: " << filename << std::endl;
-        return 1;
-    }
+    std::string text;
+    {
+        INSTRUMENT_SCOPE("10k.load");
+        std::ifstream file(filename);
+        if (!file) {
+            std::cerr << "Could not open file: " << filename << std::endl;
+            return 1;
+        }
 
-    // Use stringstream to read whole file efficiently
-    std::ostringstream ss;
-    ss << file.rdbuf();
-    std::string text = ss.str();
+        // Use stringstream to read whole file efficiently
+        std::ostringstream ss;
+        ss << file.rdbuf();
+        text = ss.str();
+        INSTRUMENT_COUNT("10k.bytes_read", text.size());
+    }
 
     // Step 2: Split the text into individual sentences
     // Regex matches sequences ending with '.', '!', or '?'
-    std::regex sentenceRegex(R"(([^.!?]*[.!?]))");
-    std::sregex_iterator begin(text.begin(), text.end(), sentenceRegex), end;
     std::vector<std::string> sentences;
-    for (auto it = begin; it != end; ++it) {
-        std::string s = it->str();
-
-        // Trim leading whitespace/newlines
-        s.erase(0, s.find_first_not_of(" \n\r\t"));
-
-        // Trim trailing whitespace/newlines
-        s.erase(s.find_last_not_of(" \n\r\t") + 1);
-        if (!s.empty()) sentences.push_back(s);
+    {
+        INSTRUMENT_SCOPE("10k.split");
+        std::regex sentenceRegex(R"(([^.!?]*[.!?]))");
+        std::sregex_iterator begin(text.begin(), text.end(), sentenceRegex), end;
+        for (auto it = begin; it != end; ++it) {
+            std::string s = it->str();
+
+            // Trim leading whitespace/newlines
+            s.erase(0, s.find_first_not_of(" \n\r\t"));
+
+            // Trim trailing whitespace/newlines
+            s.erase(s.find_last_not_of(" \n\r\t") + 1);
+            if (!s.empty()) sentences.push_back(s);
+        }
+        INSTRUMENT_COUNT("10k.sentences", sentences.size());
     }
 
     // Step 3: Build a case-insensitive regex for the user keyword
     //std::regex myRegex("\\b" + keyword + "\\b", std::regex_constants::icase);
+
+    // Step 4: Search through sentences for the keyword
+    // Matching and printing are separate passes so each can be timed on its own
+    std::vector<size_t> matches;
+    {
+        INSTRUMENT_SCOPE("10k.match");
+        for (size_t i = 0; i < sentences.size(); ++i) {
+            if (std::regex_search(sentences[i], myRegex)) matches.push_back(i);
+        }
+        INSTRUMENT_COUNT("10k.matches", matches.size());
+    }
+
+    // Step 5: Print each match with its surrounding context
+    INSTRUMENT_SCOPE("10k.print");
+    INSTRUMENT_COUNT_OUTPUT(std::cout, "10k.output_bytes");
     int snippetCount = 0;
 
     std::cout << "\nCompany name: [" << company << "]\n";
-    // Step 4: Search through sentences for the keyword and print surrounding context
-    for (size_t i = 0; i < sentences.size(); ++i) {
-        if (std::regex_search(sentences[i], myRegex)) {
-            std::cout << "\n--- " << keyword << " Snippet " << ++snippetCount << " ---\n";
+    for (size_t i : matches) {
+        std::cout << "\n--- " << keyword << " Snippet " << ++snippetCount << " ---\n";
 
-            // Include previous sentence for context, if it exists
-            if (i > 0) std::cout << sentences[i - 1] << " ";
+        // Include previous sentence for context, if it exists
+        if (i > 0) std::cout << sentences[i - 1] << " ";
 
-            // Print the sentence containing the keyword
-            std::cout << "\n\n < " << sentences[i] << " >\n\n ";
+        // Print the sentence containing the keyword
+        std::cout << "\n\n < " << sentences[i] << " >\n\n ";
 
-            // Include next sentence for context, if it exists
-            if (i + 1 < sentences.size()) std::cout << sentences[i + 1];
-            std::cout << "\n";
-        }
+        // Include next sentence for context, if it exists
+        if (i + 1 < sentences.size()) std::cout << sentences[i + 1];
+        std::cout << "\n";
     }
 
     // Inform user if no matches were found
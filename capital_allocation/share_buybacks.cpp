@@ -3,8 +3,11 @@
 #include <cmath>
 #include <string>
 
+#include "../instrumentation/instrument.h"
+
 // Utility function to format currency with abbreviations
 std::string formatCurrency(double value) {
+    INSTRUMENT_SCOPE("format.currency");
     std::string result;
 
     if (value >= 1e9) {
@@ -28,6 +31,7 @@ std::string formatCurrency(double value) {
 
 // Utility function to format share count
 std::string formatShares(double shares) {
+    INSTRUMENT_SCOPE("format.shares");
     if (shares >= 1e6) {
         std::string result = std::to_string(shares / 1e6);
         return result.substr(0, result.find('.') + 3) + "M shares";
@@ -64,6 +68,8 @@ public:
 
     // Simulate one year of operations
     void simulateYear(int year) {
+        INSTRUMENT_SCOPE("company.simulate_year");
+        INSTRUMENT_COUNT("company.years_simulated", 1);
         std::cout << "\n-----------------------------------------------" << std::endl;
         std::cout << "                   YEAR " << std::setw(2) << year << "                    " << std::endl;
         std::cout << "-----------------------------------------------" << std::endl;
@@ -111,6 +117,8 @@ public:
     }
     // Inside Company class
     void plotDividends(int years) {
+        INSTRUMENT_SCOPE("company.plot_dividends");
+        INSTRUMENT_COUNT("company.paths", 1);
         std::cout << "\n╔══════════════════════════════════════════════════╗" << std::endl;
         std::cout << "║        📊 DIVIDEND PER SHARE PROJECTION         ║" << std::endl;
         std::cout << "╚══════════════════════════════════════════════════╝" << std::endl;
@@ -134,6 +142,7 @@ public:
             double buyback_cost = shares_to_buyback * share_price;
             local_shares -= shares_to_buyback;
             local_book_value = local_book_value + retained_earnings - total_dividends - buyback_cost;
+            INSTRUMENT_COUNT("company.years_simulated", 1);
 
             // scaling factor to avoid too many dots (tune if needed)
             int dots = static_cast<int>(dividend_per_share);
@@ -148,6 +157,8 @@ public:
 
     // Project book value for multiple years
     void projectGrowth(int years) {
+        INSTRUMENT_SCOPE("company.project_growth");
+        INSTRUMENT_COUNT("company.paths", 1);
         std::cout << "\n╔══════════════════════════════════════════════════╗" << std::endl;
         std::cout << "║          📈 FINANCIAL PROJECTION MODEL          ║" << std::endl;
         std::cout << "╚══════════════════════════════════════════════════╝" << std::endl;
@@ -232,6 +243,8 @@ int buyback_go() {
     double initial_shares = 100000;       // 100K shares outstanding
     double initial_book_value = 5000000;  // $5M initial book value
 
+    INSTRUMENT_COUNT_OUTPUT(std::cout, "company.output_bytes");
+
     // Some examples
     //Company company(initial_earnings, initial_shares, initial_book_value, 0.10, 0.05, 0.30); // Example with extreme buyback
     Company company(initial_earnings, initial_shares, initial_book_value, 0.10, 0.02, 0.30);   // Example with few opportunities of buybacks
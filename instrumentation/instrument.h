@@ -0,0 +1,280 @@
+/**
+ * @file instrument.h
+ * @brief Lightweight, compile-time-removable phase timers and counters
+ *
+ * Header-only instrumentation shared by the command line tools. Everything
+ * is compiled out unless CHIKA_INSTRUMENT is defined; without it the macros
+ * below expand to ((void)0) and their arguments are never evaluated.
+ *
+ *   g++ -O2 -DCHIKA_INSTRUMENT share_buybacks.cpp
+ *
+ * Macros:
+ *   INSTRUMENT_SCOPE("phase")             time the enclosing scope
+ *   INSTRUMENT_COUNT("counter", n)        add n to a named counter
+ *   INSTRUMENT_COUNT_OUTPUT(stream, "c")  count bytes written to stream
+ *                                         until the end of the scope
+ *
+ * INSTRUMENT_COUNT_OUTPUT swaps the stream's buffer for the scope. If
+ * std::exit() skips the scope, the registry puts the original buffer back
+ * at exit; an exception escaping main() ends in std::terminate(), which
+ * neither unwinds nor flushes, so the stale buffer is never touched.
+ *
+ * Timers are inclusive: a phase nested in another is also counted in its
+ * parent. Each call site resolves its slot once (function-local static),
+ * so the hot path is a clock read and an add.
+ *
+ * The report is written to stderr at program exit, as a table by default
+ * or as JSON when CHIKA_INSTRUMENT_FORMAT=json is set in the environment.
+ *
+ * @author AI-generated
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#ifdef CHIKA_INSTRUMENT
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace chika {
+namespace instrument {
+
+/// Accumulated wall time for one named phase
+struct TimerSlot {
+    std::string name;
+    std::uint64_t calls = 0;
+    std::chrono::steady_clock::duration total{};
+};
+
+/// Running total for one named counter
+struct CounterSlot {
+    std::string name;
+    std::uint64_t value = 0;
+};
+
+/**
+ * @brief Owns every slot and prints the report when destroyed at exit
+ *
+ * Slots live in deques so references handed out to call sites stay valid
+ * as new phases and counters are registered. Streams redirected by a live
+ * ScopedOutputCounter are also tracked here, so that std::exit() still
+ * hands them back their original buffer before the library flushes them.
+ */
+class Registry {
+private:
+    std::deque<TimerSlot> timers;
+    std::deque<CounterSlot> counters;
+    std::map<std::string, TimerSlot*> timer_index;
+    std::map<std::string, CounterSlot*> counter_index;
+    std::vector<std::pair<std::ostream*, std::streambuf*>> redirects;
+
+    static std::string jsonEscape(const std::string& s) {
+        std::string out;
+        for (char c : s) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out;
+    }
+
+    static double toMillis(std::chrono::steady_clock::duration d) {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+
+    void printTable(std::ostream& os) const {
+        os << "\n=== Instrumentation ===\n";
+        os << std::left << std::setw(28) << "Phase" << std::right
+            << std::setw(10) << "Calls" << std::setw(14) << "Total ms"
+            << std::setw(14) << "Avg us" << "\n";
+        for (const TimerSlot& t : timers) {
+            double ms = toMillis(t.total);
+            double avg_us = t.calls ? ms * 1000.0 / t.calls : 0.0;
+            os << std::left << std::setw(28) << t.name << std::right
+                << std::setw(10) << t.calls
+                << std::setw(14) << std::fixed << std::setprecision(3) << ms
+                << std::setw(14) << avg_us << "\n";
+        }
+        os << "\n" << std::left << std::setw(28) << "Counter" << std::right
+            << std::setw(10) << "Value" << "\n";
+        for (const CounterSlot& c : counters) {
+            os << std::left << std::setw(28) << c.name << std::right
+                << std::setw(10) << c.value << "\n";
+        }
+    }
+
+    void printJson(std::ostream& os) const {
+        os << "{\"timers\":[";
+        for (size_t i = 0; i < timers.size(); ++i) {
+            const TimerSlot& t = timers[i];
+            os << (i ? "," : "") << "{\"name\":\"" << jsonEscape(t.name)
+                << "\",\"calls\":" << t.calls
+                << ",\"total_ms\":" << std::fixed << std::setprecision(3)
+                << toMillis(t.total) << "}";
+        }
+        os << "],\"counters\":[";
+        for (size_t i = 0; i < counters.size(); ++i) {
+            const CounterSlot& c = counters[i];
+            os << (i ? "," : "") << "{\"name\":\"" << jsonEscape(c.name)
+                << "\",\"value\":" << c.value << "}";
+        }
+        os << "]}\n";
+    }
+
+public:
+    Registry() = default;
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+
+    ~Registry() {
+        // Undo innermost redirects first so each stream ends on its original
+        while (!redirects.empty()) {
+            redirects.back().first->rdbuf(redirects.back().second);
+            redirects.pop_back();
+        }
+        if (timers.empty() && counters.empty()) return;
+        const char* format = std::getenv("CHIKA_INSTRUMENT_FORMAT");
+        if (format && std::strcmp(format, "json") == 0) printJson(std::cerr);
+        else printTable(std::cerr);
+    }
+
+    TimerSlot& timer(const char* name) {
+        auto it = timer_index.find(name);
+        if (it != timer_index.end()) return *it->second;
+        timers.emplace_back();
+        timers.back().name = name;
+        timer_index[name] = &timers.back();
+        return timers.back();
+    }
+
+    CounterSlot& counter(const char* name) {
+        auto it = counter_index.find(name);
+        if (it != counter_index.end()) return *it->second;
+        counters.emplace_back();
+        counters.back().name = name;
+        counter_index[name] = &counters.back();
+        return counters.back();
+    }
+
+    void pushRedirect(std::ostream& os, std::streambuf* original) {
+        redirects.emplace_back(&os, original);
+    }
+
+    void popRedirect() { redirects.pop_back(); }
+};
+
+/// Process-wide registry; first use happens after <iostream> is set up,
+/// so std::cerr is still alive when the report is printed at exit
+inline Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+/// Adds the lifetime of the object to a timer slot
+class ScopedTimer {
+private:
+    TimerSlot& slot;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedTimer(TimerSlot& s)
+        : slot(s), start(std::chrono::steady_clock::now()) {}
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer() {
+        slot.total += std::chrono::steady_clock::now() - start;
+        ++slot.calls;
+    }
+};
+
+/**
+ * @brief Counts bytes written to a stream while in scope
+ *
+ * Swaps the stream's buffer for a pass-through that forwards to the
+ * original buffer, and restores it on destruction. Counters must nest
+ * (scoped, never heap-allocated); if the scope is skipped by std::exit()
+ * the registry restores the buffer at exit instead.
+ */
+class ScopedOutputCounter : private std::streambuf {
+private:
+    std::ostream& stream;
+    std::streambuf* target;
+    CounterSlot& slot;
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (traits_type::eq_int_type(ch, traits_type::eof()))
+            return traits_type::not_eof(ch);
+        ++slot.value;
+        return target->sputc(traits_type::to_char_type(ch));
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        std::streamsize written = target->sputn(s, n);
+        slot.value += static_cast<std::uint64_t>(written);
+        return written;
+    }
+
+    int sync() override { return target->pubsync(); }
+
+public:
+    ScopedOutputCounter(std::ostream& os, CounterSlot& s)
+        : stream(os), target(os.rdbuf()), slot(s) {
+        stream.rdbuf(this);
+        registry().pushRedirect(stream, target);
+    }
+    ScopedOutputCounter(const ScopedOutputCounter&) = delete;
+    ScopedOutputCounter& operator=(const ScopedOutputCounter&) = delete;
+
+    ~ScopedOutputCounter() {
+        stream.flush();
+        stream.rdbuf(target);
+        registry().popRedirect();
+    }
+};
+
+} // namespace instrument
+} // namespace chika
+
+#define CHIKA_INSTRUMENT_CAT2(a, b) a##b
+#define CHIKA_INSTRUMENT_CAT(a, b) CHIKA_INSTRUMENT_CAT2(a, b)
+#define CHIKA_INSTRUMENT_ID(prefix) CHIKA_INSTRUMENT_CAT(prefix, __LINE__)
+
+#define INSTRUMENT_SCOPE(name)                                                 \
+    static ::chika::instrument::TimerSlot& CHIKA_INSTRUMENT_ID(chika_slot_) =  \
+        ::chika::instrument::registry().timer(name);                           \
+    ::chika::instrument::ScopedTimer CHIKA_INSTRUMENT_ID(chika_timer_)(        \
+        CHIKA_INSTRUMENT_ID(chika_slot_))
+
+#define INSTRUMENT_COUNT(name, n)                                              \
+    do {                                                                       \
+        static ::chika::instrument::CounterSlot& chika_slot_ =                 \
+            ::chika::instrument::registry().counter(name);                     \
+        chika_slot_.value += static_cast<std::uint64_t>(n);                    \
+    } while (0)
+
+#define INSTRUMENT_COUNT_OUTPUT(stream, name)                                  \
+    static ::chika::instrument::CounterSlot& CHIKA_INSTRUMENT_ID(chika_slot_) = \
+        ::chika::instrument::registry().counter(name);                         \
+    ::chika::instrument::ScopedOutputCounter CHIKA_INSTRUMENT_ID(chika_out_)(  \
+        stream, CHIKA_INSTRUMENT_ID(chika_slot_))
+
+#else
+
+#define INSTRUMENT_SCOPE(name) ((void)0)
+#define INSTRUMENT_COUNT(name, n) ((void)0)
+#define INSTRUMENT_COUNT_OUTPUT(stream, name) ((void)0)
+
+#endif